@@ -11,13 +11,18 @@ call :init_FadeWnd
 setlocal EnableDelayedExpansion
 for /l %%i in () do (
   %TermWnd%
-  if not errorlevel 1 goto :eof
-  set "wnd=!errorlevel!"
-  echo Term HWND:  0X!=exitcode!
-  echo(
+  if !errorlevel! equ -1 (
+    echo Term HWND:  timed out
+    echo(
+  ) else (
+    if not errorlevel 1 goto :eof
+    set "wnd=!errorlevel!"
+    echo Term HWND:  0X!=exitcode!
+    echo(
 
-  %FadeWnd% 0 1 100 1 !wnd!
-  %FadeWnd% 100 -1 0 1 !wnd!
+    %FadeWnd% 0 1 100 1 !wnd!
+    %FadeWnd% 100 -1 0 1 !wnd!
+  )
 
   REM [Terminal version >= 1.18] Gives you some time to move the tab out or attach it to another window.
   >nul timeout /t 5 /nobreak
@@ -33,6 +38,8 @@ for %%i in ("pwsh.exe") do if "%%~$PATH:i"=="" (set "ps=powershell") else set "p
 :: - BRIEF -
 ::  Get the main window handle of the terminal which is connected to the batch process.
 ::   The HWND is returned as errorlevel value.
+::   The errorlevel is -1 if the console window did not respond in time, and 0
+::    if any other error occurred.
 ::   NOTE: Only console host and Windows Terminal are supported.
 :: - SYNTAX -
 ::  %TermWnd%
@@ -72,10 +79,12 @@ set TermWnd=^
 %=========% internal static extern IntPtr OpenProcess(int Acc, int Inherit, uint ProcId);^
 %=========% [DllImport(\"kernel32.dll\", CharSet = CharSet.Unicode)]^
 %=========% internal static extern int QueryFullProcessImageNameW(IntPtr Proc, int Flgs, StringBuilder Name, ref int Size);^
-%=========% [DllImport(\"user32.dll\")]^
-%=========% internal static extern IntPtr SendMessageW(IntPtr hWnd, int Msg, IntPtr wParam, IntPtr lParam);^
+%=========% [DllImport(\"user32.dll\", SetLastError = true)]^
+%=========% internal static extern IntPtr SendMessageTimeoutW(IntPtr hWnd, int Msg, IntPtr wParam, IntPtr lParam, int Flgs, int Timeout, out IntPtr Result);^
 %=======% }^
+%=======% public enum HostVerdict { Unknown, Conhost, Terminal, Timeout, Error }^
 %=======% private static readonly IntPtr conWnd = NativeMethods.GetConsoleWindow();^
+%=======% public static HostVerdict verdict = HostVerdict.Unknown;^
 %=======% public static IntPtr hWnd = IntPtr.Zero;^
 %=======% public static uint pid = 0;^
 %=======% public static uint tid = 0;^
@@ -168,10 +177,20 @@ set TermWnd=^
 %===========% }^
 %=========% }^
 %=======% }^
-%=======% private static IntPtr GetTermWnd(ref bool terminalExpected) {^
+%=======% private static HostVerdict ProbeHost() {^
 %=========% const int WM_GETICON = 0x007F,^
-%===================% GW_OWNER = 4;^
-%=========% terminalExpected = NativeMethods.SendMessageW(conWnd, WM_GETICON, IntPtr.Zero, IntPtr.Zero) == IntPtr.Zero;^
+%===================% SMTO_ABORTIFHUNG = 0x0002,^
+%===================% SMTO_ERRORONEXIT = 0x0020,^
+%===================% ERROR_TIMEOUT = 1460,^
+%===================% probeTimeout = 200;^
+%=========% IntPtr hIcon;^
+%=========% if (NativeMethods.SendMessageTimeoutW(conWnd, WM_GETICON, IntPtr.Zero, IntPtr.Zero, SMTO_ABORTIFHUNG ^^^| SMTO_ERRORONEXIT, probeTimeout, out hIcon) == IntPtr.Zero) {^
+%===========% return Marshal.GetLastWin32Error() == ERROR_TIMEOUT ? HostVerdict.Timeout : HostVerdict.Error;^
+%=========% }^
+%=========% return hIcon == IntPtr.Zero ? HostVerdict.Terminal : HostVerdict.Conhost;^
+%=======% }^
+%=======% private static IntPtr GetTermWnd(bool terminalExpected) {^
+%=========% const int GW_OWNER = 4;^
 %=========% if (terminalExpected == false) { return conWnd; }^
 %=========% IntPtr conOwner = IntPtr.Zero;^
 %=========% for (int i = 0; i ^^^< 100 ^^^&^^^& conOwner == IntPtr.Zero; ++i) {^
@@ -186,8 +205,11 @@ set TermWnd=^
 %=======% }^
 %=======% static WinTerm() {^
 %=========% const int PROCESS_QUERY_LIMITED_INFORMATION = 0x1000;^
-%=========% bool terminalExpected = false;^
-%=========% hWnd = GetTermWnd(ref terminalExpected);^
+%=========% verdict = ProbeHost();^
+%=========% if (verdict == HostVerdict.Timeout) { return; }^
+%=========% if (verdict == HostVerdict.Error) { throw new InvalidOperationException(); }^
+%=========% bool terminalExpected = verdict == HostVerdict.Terminal;^
+%=========% hWnd = GetTermWnd(terminalExpected);^
 %=========% if (hWnd == IntPtr.Zero)^
 %===========% throw new InvalidOperationException();^
 %=========% tid = NativeMethods.GetWindowThreadProcessId(hWnd, out pid);^
@@ -201,6 +223,7 @@ set TermWnd=^
 %=======% }^
 %=====% }^
 %===% ' } catch {};^
+%===% if (('WinTerm' -as [type]) -and [WinTerm]::verdict -eq 'Timeout') { exit -1 };^
 %===% $hWnd = if ('WinTerm' -as [type]) { [WinTerm]::hWnd } else { [IntPtr]::Zero };^
 %===% exit [Int32]$hWnd;^
 %=% ^"
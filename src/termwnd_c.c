@@ -30,12 +30,25 @@
 #include <stdio.h>
 #include <wchar.h>
 
+// outcome of probing the console window
+typedef enum
+{
+  HostUnknown, // not yet probed
+  HostConhost,
+  HostTerminal,
+  HostTimeout, // the console window did not respond in time, the other properties have not been updated
+  HostError // the console window could not be probed, the other properties have not been updated
+} HostVerdict;
+
+// zero-initialize before the first call of GetWinterm()
 typedef struct
 {
   HWND hwnd;
   DWORD pid;
   DWORD tid;
   wchar_t basename[MAX_PATH];
+  HWND conwnd; // console window the verdict belongs to
+  HostVerdict verdict; // outcome of the latest probe, only HostConhost and HostTerminal are reused for the same conwnd
 } winterm_t;
 
 bool GetWinterm(winterm_t *pWinterm);
@@ -70,9 +83,9 @@ void Fade(const HWND hWnd, const FadeMode mode);
 
 int main(void)
 {
-  for (winterm_t winterm;;)
+  for (winterm_t winterm = { 0 };;)
   {
-    if (!GetWinterm(&winterm))
+    if (!GetWinterm(&winterm) && winterm.verdict != HostTimeout)
       return 1;
 
     wprintf_s(L"Term proc: %s\nTerm PID:  %lu\nTerm TID:  %lu\nTerm HWND: 0X%08IX\n\n", winterm.basename, winterm.pid, winterm.tid, (intptr_t)(void *)winterm.hwnd);
@@ -227,16 +240,26 @@ static BOOL __stdcall GetTermWndCallback(HWND hWnd, LPARAM lParam)
   return FALSE;
 }
 
-static HWND GetTermWnd(bool *const pTerminalExpected)
+static HostVerdict ProbeHost(const HWND conWnd)
 {
-  const HWND conWnd = GetConsoleWindow();
+  static const UINT probeTimeout = 200; // milliseconds
+
   // We don't have a proper way to figure out to what terminal app the Shell process
   // is connected on the local machine:
   // https://github.com/microsoft/terminal/issues/7434
   // We're getting around this assuming we don't get an icon handle from the
   // invisible Conhost window when the Shell is connected to Windows Terminal.
-  *pTerminalExpected = SendMessageW(conWnd, WM_GETICON, 0, 0) == 0;
-  if (!*pTerminalExpected)
+  // SendMessageW() would block without a time limit if the Conhost process is busy or hung.
+  DWORD_PTR hIcon = 0;
+  if (!SendMessageTimeoutW(conWnd, WM_GETICON, 0, 0, SMTO_ABORTIFHUNG | SMTO_ERRORONEXIT, probeTimeout, &hIcon))
+    return GetLastError() == ERROR_TIMEOUT ? HostTimeout : HostError;
+
+  return hIcon == 0 ? HostTerminal : HostConhost;
+}
+
+static HWND GetTermWnd(const HWND conWnd, const bool terminalExpected)
+{
+  if (!terminalExpected)
     return conWnd;
 
   // Polling because it may take some milliseconds for Terminal to create its window and take ownership of the hidden ConPTY window.
@@ -266,27 +289,51 @@ static HWND GetTermWnd(bool *const pTerminalExpected)
 
 bool GetWinterm(winterm_t *pWinterm)
 {
-  bool terminalExpected = false;
-  pWinterm->hwnd = GetTermWnd(&terminalExpected);
-  if (pWinterm->hwnd == NULL)
+  const HWND conWnd = GetConsoleWindow();
+  // The verdict can't change as long as we are attached to the same console window. Thus, it is cached to avoid another cross-process call.
+  if (conWnd != pWinterm->conwnd || (pWinterm->verdict != HostConhost && pWinterm->verdict != HostTerminal))
+  {
+    pWinterm->conwnd = conWnd;
+    pWinterm->verdict = ProbeHost(conWnd);
+  }
+
+  if (pWinterm->verdict == HostTimeout || pWinterm->verdict == HostError)
+    return false; // don't guess, keep the previous properties and probe again in the next call
+
+  const bool terminalExpected = pWinterm->verdict == HostTerminal;
+  const HWND hWnd = GetTermWnd(conWnd, terminalExpected);
+  if (hWnd == NULL)
     return false;
 
-  pWinterm->tid = GetWindowThreadProcessId(pWinterm->hwnd, &(pWinterm->pid));
-  if (pWinterm->tid == 0)
+  DWORD pid = 0;
+  const DWORD tid = GetWindowThreadProcessId(hWnd, &pid);
+  if (tid == 0)
     return false;
 
-  const HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pWinterm->pid);
+  const HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
   if (hProc == NULL)
     return false;
 
-  GetProcBaseName(hProc, pWinterm->basename, ARRAYSIZE(pWinterm->basename));
+  wchar_t baseName[MAX_PATH] = { 0 };
+  GetProcBaseName(hProc, baseName, ARRAYSIZE(baseName));
   CloseHandle(hProc);
 
-  return *(pWinterm->basename) != L'\0' && (!terminalExpected || wcscmp(pWinterm->basename, L"WindowsTerminal") == 0);
+  if (*baseName == L'\0' || (terminalExpected && wcscmp(baseName, L"WindowsTerminal") != 0))
+    return false;
+
+  // only update the properties if all of them have been determined
+  pWinterm->hwnd = hWnd;
+  pWinterm->pid = pid;
+  pWinterm->tid = tid;
+  wcscpy_s(pWinterm->basename, ARRAYSIZE(pWinterm->basename), baseName);
+  return true;
 }
 
 void Fade(const HWND hWnd, const FadeMode mode)
 {
+  if (hWnd == NULL)
+    return;
+
   SetWindowLongW(hWnd, GWL_EXSTYLE, GetWindowLongW(hWnd, GWL_EXSTYLE) | WS_EX_LAYERED);
 
   if (mode == FadeOut)
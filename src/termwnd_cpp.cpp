@@ -86,8 +86,20 @@ namespace termproc
   // provides properties identifying the terminal window the current console application is running in
   class winterm
   {
+  public:
+    // outcome of probing the console window, see verdict()
+    enum class HostVerdict
+    {
+      Unknown, // not yet probed
+      Conhost,
+      Terminal,
+      Timeout, // the console window did not respond in time, the other properties have not been updated
+      Error // the console window could not be probed, the other properties have not been updated
+    };
+
   private:
     HWND m_conWnd{ ::GetConsoleWindow() };
+    HostVerdict m_verdict{ HostVerdict::Unknown }; // only Conhost and Terminal are reused for the same m_conWnd
     HWND m_hWnd{};
     DWORD m_pid{};
     DWORD m_tid{};
@@ -193,15 +205,25 @@ namespace termproc
       return FALSE;
     }
 
-    HWND GetTermWnd(bool &terminalExpected)
+    static HostVerdict ProbeHost(const HWND conWnd) noexcept
     {
-      const auto conWnd{ ::GetConsoleWindow() };
+      static constexpr UINT probeTimeout{ 200 }; // milliseconds
+
       // We don't have a proper way to figure out to what terminal app the Shell process
       // is connected on the local machine:
       // https://github.com/microsoft/terminal/issues/7434
       // We're getting around this assuming we don't get an icon handle from the
       // invisible Conhost window when the Shell is connected to Windows Terminal.
-      terminalExpected = ::SendMessageW(conWnd, WM_GETICON, 0, 0) == 0;
+      // SendMessageW() would block without a time limit if the Conhost process is busy or hung.
+      DWORD_PTR hIcon{};
+      if (!::SendMessageTimeoutW(conWnd, WM_GETICON, 0, 0, SMTO_ABORTIFHUNG | SMTO_ERRORONEXIT, probeTimeout, &hIcon))
+        return ::GetLastError() == ERROR_TIMEOUT ? HostVerdict::Timeout : HostVerdict::Error;
+
+      return hIcon == 0 ? HostVerdict::Terminal : HostVerdict::Conhost;
+    }
+
+    HWND GetTermWnd(const HWND conWnd, const bool terminalExpected)
+    {
       if (!terminalExpected)
         return conWnd;
 
@@ -243,23 +265,41 @@ namespace termproc
     {
       try
       {
-        bool terminalExpected = false;
-        m_hWnd = GetTermWnd(terminalExpected);
-        if (m_hWnd == nullptr)
+        const auto conWnd{ ::GetConsoleWindow() };
+        // The verdict can't change as long as we are attached to the same console window. Thus, it is cached to avoid another cross-process call.
+        if (conWnd != m_conWnd || (m_verdict != HostVerdict::Conhost && m_verdict != HostVerdict::Terminal))
+        {
+          m_conWnd = conWnd;
+          m_verdict = ProbeHost(conWnd);
+        }
+
+        if (m_verdict == HostVerdict::Timeout || m_verdict == HostVerdict::Error)
+          return; // don't guess, keep the previous properties and probe again in the next call
+
+        const bool terminalExpected{ m_verdict == HostVerdict::Terminal };
+        const auto hWnd{ GetTermWnd(conWnd, terminalExpected) };
+        if (hWnd == nullptr)
           throw std::exception{};
 
-        m_tid = ::GetWindowThreadProcessId(m_hWnd, &(m_pid));
-        if (m_tid == 0)
+        DWORD pid{};
+        const auto tid{ ::GetWindowThreadProcessId(hWnd, &pid) };
+        if (tid == 0)
           throw std::exception{};
 
-        const auto sHProc{ saferes::MakeHandle(::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, m_pid)) };
+        const auto sHProc{ saferes::MakeHandle(::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid)) };
         if (saferes::IsInvalidHandle(sHProc))
           throw std::exception{};
 
         std::array<wchar_t, 1024> nameBuf{};
-        m_baseName = GetProcBaseName(sHProc.get(), nameBuf);
-        if (m_baseName.empty() || (terminalExpected && m_baseName != L"WindowsTerminal"))
+        auto baseName{ GetProcBaseName(sHProc.get(), nameBuf) };
+        if (baseName.empty() || (terminalExpected && baseName != L"WindowsTerminal"))
           throw std::exception{};
+
+        // only update the properties if all of them have been determined
+        m_hWnd = hWnd;
+        m_pid = pid;
+        m_tid = tid;
+        m_baseName = std::move(baseName);
       }
       catch (...)
       {
@@ -285,6 +325,11 @@ namespace termproc
     {
       return m_baseName;
     }
+
+    constexpr HostVerdict verdict() const noexcept // outcome of the latest probe of the console window
+    {
+      return m_verdict;
+    }
   };
 }
 
@@ -327,6 +372,9 @@ int main()
 
 void test::Fade(const HWND hWnd, const FadeMode mode) noexcept
 {
+  if (hWnd == nullptr)
+    return;
+
   ::SetWindowLongW(hWnd, GWL_EXSTYLE, ::GetWindowLongW(hWnd, GWL_EXSTYLE) | WS_EX_LAYERED);
 
   constexpr std::ranges::iota_view rng{ 0, 86 };
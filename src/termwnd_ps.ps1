@@ -36,8 +36,17 @@ try { Add-Type -EA SilentlyContinue -TypeDefinition @'
       internal static extern IntPtr OpenProcess(int Acc, int Inherit, uint ProcId);
       [DllImport("kernel32.dll", CharSet = CharSet.Unicode)]
       internal static extern int QueryFullProcessImageNameW(IntPtr Proc, int Flgs, StringBuilder Name, ref int Size);
-      [DllImport("user32.dll")]
-      internal static extern IntPtr SendMessageW(IntPtr hWnd, int Msg, IntPtr wParam, IntPtr lParam);
+      [DllImport("user32.dll", SetLastError = true)]
+      internal static extern IntPtr SendMessageTimeoutW(IntPtr hWnd, int Msg, IntPtr wParam, IntPtr lParam, int Flgs, int Timeout, out IntPtr Result);
+    }
+
+    //# outcome of probing the console window, see [WinTerm]::Verdict
+    public enum HostVerdict {
+      Unknown, //# not yet probed
+      Conhost,
+      Terminal,
+      Timeout, //# the console window did not respond in time, the other properties have not been updated
+      Error //# the console window could not be probed
     }
 
     private static readonly IntPtr conWnd = NativeMethods.GetConsoleWindow();
@@ -46,11 +55,13 @@ try { Add-Type -EA SilentlyContinue -TypeDefinition @'
     public static uint Pid { get { return pid; } } //# process id
     public static uint Tid { get { return tid; } } //# thread id
     public static string BaseName { get { return baseName; } } //# process name without .exe extension
+    public static HostVerdict Verdict { get { return verdict; } } //# outcome of the latest probe of the console window
 
     private static IntPtr hWnd = IntPtr.Zero;
     private static uint pid = 0;
     private static uint tid = 0;
     private static string baseName = string.Empty;
+    private static HostVerdict verdict = HostVerdict.Unknown; //# only Conhost and Terminal are reused
 
     //# owns an unmanaged resource
     //# the ctor qualifies a SafeRes object to manage either a pointer received from Marshal.AllocHGlobal(), or a handle
@@ -178,16 +189,29 @@ try { Add-Type -EA SilentlyContinue -TypeDefinition @'
       }
     }
 
-    private static IntPtr GetTermWnd(ref bool terminalExpected) {
+    private static HostVerdict ProbeHost() {
       const int WM_GETICON = 0x007F,
-                GW_OWNER = 4;
+                SMTO_ABORTIFHUNG = 0x0002,
+                SMTO_ERRORONEXIT = 0x0020,
+                ERROR_TIMEOUT = 1460,
+                probeTimeout = 200; //# milliseconds
 
       //# We don't have a proper way to figure out to what terminal app the Shell process
       //# is connected on the local machine:
       //# https://github.com/microsoft/terminal/issues/7434
       //# We're getting around this assuming we don't get an icon handle from the
       //# invisible Conhost window when the Shell is connected to Windows Terminal.
-      terminalExpected = NativeMethods.SendMessageW(conWnd, WM_GETICON, IntPtr.Zero, IntPtr.Zero) == IntPtr.Zero;
+      //# SendMessageW() would block without a time limit if the Conhost process is busy or hung.
+      IntPtr hIcon;
+      if (NativeMethods.SendMessageTimeoutW(conWnd, WM_GETICON, IntPtr.Zero, IntPtr.Zero, SMTO_ABORTIFHUNG | SMTO_ERRORONEXIT, probeTimeout, out hIcon) == IntPtr.Zero)
+        return Marshal.GetLastWin32Error() == ERROR_TIMEOUT ? HostVerdict.Timeout : HostVerdict.Error;
+
+      return hIcon == IntPtr.Zero ? HostVerdict.Terminal : HostVerdict.Conhost;
+    }
+
+    private static IntPtr GetTermWnd(bool terminalExpected) {
+      const int GW_OWNER = 4;
+
       if (!terminalExpected)
         return conWnd;
 
@@ -219,24 +243,42 @@ try { Add-Type -EA SilentlyContinue -TypeDefinition @'
     //# used to initially get or to update the properties if a terminal tab is moved to another window
     public static void Refresh() {
       const int PROCESS_QUERY_LIMITED_INFORMATION = 0x1000;
-      bool terminalExpected = false;
-      hWnd = GetTermWnd(ref terminalExpected);
-      if (hWnd == IntPtr.Zero)
+      //# The verdict can't change for our console window. Thus, it is cached to avoid another cross-process call.
+      if (verdict != HostVerdict.Conhost && verdict != HostVerdict.Terminal)
+        verdict = ProbeHost();
+
+      if (verdict == HostVerdict.Timeout)
+        return; //# don't guess, keep the previous properties and probe again in the next call
+
+      if (verdict == HostVerdict.Error)
         throw new InvalidOperationException();
 
-      tid = NativeMethods.GetWindowThreadProcessId(hWnd, out pid);
-      if (tid == 0)
+      bool terminalExpected = verdict == HostVerdict.Terminal;
+      IntPtr termWnd = GetTermWnd(terminalExpected);
+      if (termWnd == IntPtr.Zero)
         throw new InvalidOperationException();
 
-      using (SafeRes sHProc = new SafeRes(NativeMethods.OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, 0, pid), SafeRes.ResType.Handle)) {
+      uint termPid;
+      uint termTid = NativeMethods.GetWindowThreadProcessId(termWnd, out termPid);
+      if (termTid == 0)
+        throw new InvalidOperationException();
+
+      string termBaseName;
+      using (SafeRes sHProc = new SafeRes(NativeMethods.OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, 0, termPid), SafeRes.ResType.Handle)) {
         if (sHProc.IsInvalid)
           throw new InvalidOperationException();
 
-        baseName = GetProcBaseName(sHProc);
+        termBaseName = GetProcBaseName(sHProc);
       }
 
-      if (string.IsNullOrEmpty(baseName) || (terminalExpected && baseName != "WindowsTerminal"))
+      if (string.IsNullOrEmpty(termBaseName) || (terminalExpected && termBaseName != "WindowsTerminal"))
         throw new InvalidOperationException();
+
+      //# only update the properties if all of them have been determined
+      hWnd = termWnd;
+      pid = termPid;
+      tid = termTid;
+      baseName = termBaseName;
     }
   }
 '@ } catch {}